@@ -1,26 +1,20 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <fstream>
-#include <stdexcept>
-#include <exception>
-#include <iomanip>
-#include <algorithm>
-#include <ctime>
-#include <map>
-#include <cctype>
-#include <limits>
+#include "rental_core.h"
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#endif
+#include <shared_mutex>
+#include <deque>
+#include <csignal>
+#include <cerrno>
 #include <conio.h>
 
 using namespace std;
 
-// Helper: Convert string to uppercase for case-insensitive comparison
-string toUpper(const string& s) {
-    string out = s;
-    transform(out.begin(), out.end(), out.begin(), ::toupper);
-    return out;
-}
-
+// --- Console Input ---
 string getPasswordMasked() {
     string password;
     char ch;
@@ -39,265 +33,59 @@ string getPasswordMasked() {
     return password;
 }
 
-// Helper: Get numeric input with validation
-int getNumericInput(const string& prompt) {
+int getNumericInputInRange(const string& prompt, int min, int max) {
     string input;
     int value;
     while (true) {
         cout << prompt;
-        cin >> input;
-        bool isNumeric = !input.empty() && all_of(input.begin(), input.end(), ::isdigit);
-        if (isNumeric) {
+        getline(cin >> ws, input); // Read the whole line, skip leading whitespace
+        // Check if input is a single number (no spaces, all digits)
+        if (!input.empty() && all_of(input.begin(), input.end(), ::isdigit)) {
             value = stoi(input);
-            break;
+            if (value >= min && value <= max) {
+                break;
+            } else {
+                cout << "Invalid input. Please enter the right number.\n";
+            }
         } else {
-            cout << "Invalid input. Please enter numbers only.\n";
+            cout << "Invalid input. Please enter the right number.\n";
         }
     }
     return value;
 }
 
-// --- Car Class with Plate Number and Status ---
-class Car {
-public:
-    Car(string id, string model, string plateNumber, string status = "Available")
-        : id(id), model(model), plateNumber(plateNumber), status(status) {}
-
-    string getId() const { return id; }
-    string getModel() const { return model; }
-    string getPlateNumber() const { return plateNumber; }
-    string getStatus() const { return status; }
-    void setStatus(const string& newStatus) { status = newStatus; }
-    void setModel(const string& newModel) { model = newModel; }
-    void setPlateNumber(const string& newPlate) { plateNumber = newPlate; }
-    bool isAvailable() const { return status == "Available"; }
-
-private:
-    string id;
-    string model;
-    string plateNumber;
-    string status; // Available, Rented, Maintenance, etc.
-};
-
-class PricingStrategy {
-public:
-    virtual double calculatePrice(int days) = 0;
-    virtual ~PricingStrategy() {}
-};
-
-class StandardPricing : public PricingStrategy {
-public:
-    double calculatePrice(int days) override {
-        return days * 500.0;
-    }
-};
-
-class PremiumPricing : public PricingStrategy {
-public:
-    double calculatePrice(int days) override {
-        return days * 1000.0;
-    }
-};
-
-// --- Reservation Class with Payment Status ---
-class Reservation {
-public:
-    Reservation(string carId, string username, string startDate, string endDate, double price, string status = "Pending", string paymentStatus = "Pending")
-        : carId(carId), username(username), startDate(startDate), endDate(endDate), price(price), status(status), paymentStatus(paymentStatus) {}
-
-    string getCarId() const { return carId; }
-    string getUsername() const { return username; }
-    string getStartDate() const { return startDate; }
-    string getEndDate() const { return endDate; }
-    double getPrice() const { return price; }
-    string getStatus() const { return status; }
-    string getPaymentStatus() const { return paymentStatus; }
-    void setStatus(const string& newStatus) { status = newStatus; }
-    void setPaymentStatus(const string& newStatus) { paymentStatus = newStatus; }
-
-private:
-    string carId;
-    string username;
-    string startDate;
-    string endDate;
-    double price;
-    string status;
-    string paymentStatus;
-};
-
-void saveReservationsToFile(const std::vector<Reservation>& reservations);
-
-// --- User Class with Cancel Reservation and Change Password ---
-class User {
-public:
-    User(string username, string password) : username(username), password(password) {}
-    vector<Reservation>* getReservations() const { return reservations; }
-
-    string getUsername() const { return username; }
-    string getPassword() const { return password; }
-    bool login(string user, string pass) {
-        return (user == username && pass == password);
-    }
-
-    void rentCar(const string& id, PricingStrategy* strategy, int days, vector<Car>& cars);
-    void viewAvailableCars() const;
-    void viewMyReservations() const;
-    void cancelReservation(const string& carId, vector<Car>& cars);
-    void changePassword(const string& newPassword);
-    void payForReservation();
+// --- Interactive Flows ---
+void registerUser(UserRegistry& users, CarRegistry& cars) {
+    string username, password;
 
-    void logAction(const string& action) {
-        ofstream logFile("log.txt", ios::app);
-        logFile << action << endl;
+    cout << "Enter new username: ";
+    cin >> username;
+    if (username.empty()) {
+        cout << "Username cannot be empty.\n";
+        return;
     }
-
-    void setCars(vector<Car>* carList) { cars = carList; }
-    void setReservations(vector<Reservation>* resList) { reservations = resList; }
-    
-    
-
-private:
-    string username;
-    string password;
-    vector<Car>* cars;
-    vector<Reservation>* reservations;
-};
-
-void User::changePassword(const string& newPassword) {
-    if (newPassword.empty()) {
-        cout << "Password cannot be empty.\n";
+    if (users.find(username)) {
+        cout << "Username already exists. Try again.\n";
         return;
     }
-    password = newPassword;
-    cout << "Password changed.\n";
-}
 
-void User::viewAvailableCars() const {
-    cout << "\nAvailable Cars:\n";
-    cout << left << setw(15) << "Car ID" << setw(20) << "Model" << setw(15) << "Plate No."
-         << setw(15) << "Status" << setw(15) << "Price/Day" << endl;
-    cout << string(80, '-') << endl;
-    for (const auto& car : *cars) {
-        if (car.isAvailable()) {
-            cout << left << setw(15) << car.getId()
-                 << setw(20) << car.getModel()
-                 << setw(15) << car.getPlateNumber()
-                 << setw(15) << car.getStatus()
-                 << setw(15) << 500.0 << endl; // Or use car.getPricePerDay() if you add that field
-        }
+    cout << "Enter new password: ";
+    password = getPasswordMasked();
+    if (password.empty() || password.find(' ') != string::npos) {
+        cout << "Password cannot be empty or contain spaces.\n";
+        return;
     }
-}
 
-// ...existing code...
-void User::viewMyReservations() const {
-    cout << "\nMy Reservations:\n";
-    cout << left << setw(15) << "Car ID" << setw(15) << "Start Date" << setw(15) << "End Date"
-         << setw(15) << "Price" << setw(15) << "Status" << setw(15) << "Payment" << endl;
-    cout << string(90, '-') << endl;
-
-    bool found = false;
-    for (auto& res : *reservations) {
-        if (res.getUsername() == username) {
-            found = true;
-            // If status is Cancelled, set payment status to Cancelled as well
-            if (toUpper(res.getStatus()) == "CANCELLED" && res.getPaymentStatus() != "Cancelled") {
-                res.setPaymentStatus("Cancelled");
-                saveReservationsToFile(*reservations);
-            }
-            cout << left << setw(15) << res.getCarId()
-                 << setw(15) << res.getStartDate()
-                 << setw(15) << res.getEndDate()
-                 << setw(15) << res.getPrice()
-                 << setw(15) << res.getStatus()
-                 << setw(15) << res.getPaymentStatus() << endl;
-        }
-    }
-    if (!found) {
-        cout << "No reservation\n";
-    }
-}
+    User newUser(username, password);
+    newUser.setCars(&cars);
+    users.add(newUser);
 
-void User::payForReservation() {
-    bool found = false;
-    cout << "\nUnpaid Reservations:\n";
-    cout << left << setw(15) << "Car ID" << setw(15) << "Start Date" << setw(15) << "End Date"
-         << setw(15) << "Price" << setw(15) << "Status" << setw(15) << "Payment" << endl;
-    cout << string(90, '-') << endl;
-    vector<string> unpaidCarIds;
-    for (const auto& res : *reservations) {
-        if (res.getUsername() == username && res.getPaymentStatus() == "Pending" && toUpper(res.getStatus()) == "CONFIRMED") {
-            found = true;
-            cout << left << setw(15) << res.getCarId()
-                 << setw(15) << res.getStartDate()
-                 << setw(15) << res.getEndDate()
-                 << setw(15) << res.getPrice()
-                 << setw(15) << res.getStatus()
-                 << setw(15) << res.getPaymentStatus() << endl;
-            unpaidCarIds.push_back(toUpper(res.getCarId()));
-        }
-    }
-    if (!found) {
-        cout << "No unpaid confirmed reservations found.\n";
-        return;
-    }
-    string carId;
-    while (true) {
-        cout << "Enter Car ID to pay for: ";
-        cin >> carId;
-        if (find(unpaidCarIds.begin(), unpaidCarIds.end(), toUpper(carId)) != unpaidCarIds.end()) {
-            break;
-        } else {
-            cout << "Car ID not found in your unpaid confirmed reservations. Please try again.\n";
-        }
-    }
-    for (auto& res : *reservations) {
-        if (res.getUsername() == username && toUpper(res.getCarId()) == toUpper(carId) && res.getPaymentStatus() == "Pending" && toUpper(res.getStatus()) == "CONFIRMED") {
-            int payMethod;
-            cout << "Select payment method:\n1. Cash\n2. Card\nChoose: ";
-            payMethod = getNumericInput("");
-            if (payMethod == 2) {
-                string cardNum;
-                cout << "Enter 16-digit card number: ";
-                cin >> cardNum;
-                while (cardNum.length() != 16 || !all_of(cardNum.begin(), cardNum.end(), ::isdigit)) {
-                    cout << "Invalid card number. Enter 16-digit card number: ";
-                    cin >> cardNum;
-                }
-                cout << "Card payment accepted.\n";
-            } else {
-                cout << "Cash payment accepted.\n";
-            }
-            res.setPaymentStatus("Paid");
-            saveReservationsToFile(*reservations);
-            cout << "Payment successful for reservation " << carId << ".\n";
-            return;
-        }
-    }
-    cout << "Reservation not found or already paid.\n";
-}
+    journalUser(newUser);
 
-void User::cancelReservation(const string& carId, vector<Car>& carsVec) {
-    string carIdUpper = toUpper(carId);
-    for (auto& res : *reservations) {
-        if (toUpper(res.getCarId()) == carIdUpper && res.getUsername() == username && res.getStatus() != "Cancelled") {
-            res.setStatus("Cancelled");
-            // Update car status to Available if reservation is cancelled
-            for (auto& car : carsVec) {
-                if (toUpper(car.getId()) == carIdUpper) {
-                    car.setStatus("Available");
-                    break;
-                }
-            }
-            logAction("User " + username + " cancelled reservation for car ID " + carId);
-            saveReservationsToFile(*reservations);
-            cout << "Reservation cancelled.\n";
-            return;
-        }
-    }
-    cout << "No active reservation found for this car.\n";
+    cout << "Registration successful! You can now log in.\n";
 }
 
-void cancelReservationWithPrompt(User& user, vector<Car>& cars) {
+void cancelReservationWithPrompt(User& user, CarRegistry& cars) {
     // Show user's active reservations
 
     bool found = false;
@@ -305,8 +93,10 @@ void cancelReservationWithPrompt(User& user, vector<Car>& cars) {
     cout << left << setw(15) << "Car ID" << setw(15) << "Start Date" << setw(15) << "End Date"
          << setw(15) << "Price" << setw(15) << "Status" << setw(15) << "Payment" << endl;
     cout << string(90, '-') << endl;
-    for (const auto& res : *(user.getReservations())) {
-        if (res.getUsername() == user.getUsername() && res.getStatus() != "Cancelled") {
+    const ReservationStore& reservations = *user.getReservations();
+    for (size_t pos : reservations.forUser(user.getUsername())) {
+        const Reservation& res = reservations[pos];
+        if (!res.isCancelled()) {
             found = true;
             cout << left << setw(15) << res.getCarId()
                  << setw(15) << res.getStartDate()
@@ -334,10 +124,9 @@ void cancelReservationWithPrompt(User& user, vector<Car>& cars) {
             }
             // Check if Car ID exists in user's active reservations
             bool exists = false;
-            for (const auto& res : *(user.getReservations())) {
-                if (toUpper(res.getCarId()) == toUpper(carId) &&
-                    res.getUsername() == user.getUsername() &&
-                    res.getStatus() != "Cancelled") {
+            for (size_t pos : reservations.forUser(user.getUsername())) {
+                const Reservation& res = reservations[pos];
+                if (equalsNoCase(res.getCarId(), carId) && !res.isCancelled()) {
                     exists = true;
                     break;
                 }
@@ -365,197 +154,62 @@ void cancelReservationWithPrompt(User& user, vector<Car>& cars) {
     }
 }
 
-// --- Admin Class with User Management ---
-class Admin {
-public:
-    Admin() : reservations(nullptr) {}
-
-    void addCar(const string& id, const string& model, const string& plateNumber);
-    void viewCars() const;
-    void updateCar(const string& id, const string& newModel);
-    void deleteCar(const string& id);
-    void filterCarsByModel(const string& keyword) const;
-    void viewAllReservations();
-    void updateReservationStatus(const string& carId, const string& username, const string& newStatus, vector<Car>& cars, vector<Reservation>& reservations);
-    void viewUsers(const vector<User>& users) const;
-    void deleteUser(vector<User>& users, const string& username);
-
-    vector<Car>& getCars() { return cars; }
-    void setReservations(vector<Reservation>* resList) { reservations = resList; }
-    vector<Reservation>& getReservations() { return *reservations; }
-    const vector<Reservation>& getReservations() const { return *reservations; }
-
-private:
-    vector<Car> cars;
-    vector<Reservation>* reservations; // pointer to global reservations
-};
-
-// --- File I/O Updated for New Fields ---
-void saveCarsToFile(const vector<Car>& cars) {
-    ofstream file("cars.txt");
-    for (const auto& car : cars) {
-        file << car.getId() << " " << car.getModel() << " " << car.getPlateNumber() << " " << car.getStatus() << endl;
-    }
-    file.close();
-}
-
-void loadCarsFromFile(vector<Car>& cars) {
-    cars.clear();
-    ifstream file("cars.txt");
-    string id, model, plateNumber, status;
-    while (file >> id >> model >> plateNumber >> status) {
-        if (id.empty() || model.empty() || plateNumber.empty() || status.empty())
-            continue; // skip malformed lines
-        cars.emplace_back(id, model, plateNumber, status);
-    }
-    file.close();
-}
-
-void saveUsersToFile(const vector<User>& users) {
-    ofstream fout("users.txt");
-    for (const auto& user : users) {
-        fout << user.getUsername() << " " << user.getPassword() << "\n";
-    }
-    fout.close();
-}
-
-void loadUsersFromFile(vector<User>& users, vector<Car>& cars) {
-    ifstream file("users.txt");
-    string username, password;
-    while (file >> username >> password) {
-        users.emplace_back(username, password);
-        users.back().setCars(&cars);
-    }
-    file.close();
-}
-
-void saveReservationsToFile(const vector<Reservation>& reservations) {
-    ofstream file("reservations.txt");
-    for (const auto& res : reservations) {
-        file << res.getCarId() << " " << res.getUsername() << " "
-             << res.getStartDate() << " " << res.getEndDate() << " "
-             << res.getPrice() << " " << res.getStatus() << " " << res.getPaymentStatus() << endl;
-    }
-    file.close();
-}
-
-void loadReservationsFromFile(vector<Reservation>& reservations) {
-    ifstream file("reservations.txt");
-    string carId, username, startDate, endDate, status, paymentStatus;
-    double price;
-    while (file >> carId >> username >> startDate >> endDate >> price >> status >> paymentStatus) {
-        reservations.emplace_back(carId, username, startDate, endDate, price, status, paymentStatus);
-    }
-    file.close();
-}
-
-void registerUser(vector<User>& users, vector<Car>& cars) {
-    string username, password;
+// ...existing code...
+// Asks for a start and an end date (YYYY-MM-DD) until both are valid and in order
+void promptDateRange(Date& startDate, Date& endDate) {
+    auto isValidDate = [](const string& text, Date& date) {
+        if (text.length() != 10) return false;
+        if (text[4] != '-' || text[7] != '-') return false;
+        return Date::parse(text, date);
+    };
+    string text;
 
-    cout << "Enter new username: ";
-    cin >> username;
-    if (username.empty()) {
-        cout << "Username cannot be empty.\n";
-        return;
-    }
-    for (const auto& user : users) {
-        if (user.getUsername() == username) {
-            cout << "Username already exists. Try again.\n";
-            return;
+    // Ask for start date until valid
+    while (true) {
+        cout << "Enter start date: ";
+        cin >> text;
+        if (!isValidDate(text, startDate)) {
+            cout << "Invalid date. Please use YYYY-MM-DD.\n";
+            continue;
         }
+        break;
     }
 
-    cout << "Enter new password: ";
-    password = getPasswordMasked();
-    if (password.empty() || password.find(' ') != string::npos) {
-        cout << "Password cannot be empty or contain spaces.\n";
-        return;
-    }
-
-    users.emplace_back(username, password);
-    users.back().setCars(&cars);
-
-    saveUsersToFile(users);
-
-    cout << "Registration successful! You can now log in.\n";
-}
-
-string getCurrentDate() {
-    time_t now = time(0);
-    tm* ltm = localtime(&now);
-    return to_string(1900 + ltm->tm_year) + "-" + to_string(1 + ltm->tm_mon) + "-" + to_string(ltm->tm_mday);
-}
-
-string calculateEndDate(const string& startDate, int days) {
-    size_t dash1 = startDate.find('-');
-    size_t dash2 = startDate.find('-', dash1 + 1);
-
-    int year = stoi(startDate.substr(0, dash1));
-    int month = stoi(startDate.substr(dash1 + 1, dash2 - dash1 - 1));
-    int day = stoi(startDate.substr(dash2 + 1));
-
-    day += days;
-
-    if (day > 30) {
-        month += day / 30;
-        day = day % 30;
-    }
-    if (month > 12) {
-        year += month / 12;
-        month = month % 12;
-    }
-
-    return to_string(year) + "-" + to_string(month) + "-" + to_string(day);
-}
-
-// --- Reservation Conflict Check ---
-bool isReservationConflict(const vector<Reservation>& reservations, const string& carId, const string& startDate, const string& endDate) {
-    for (const auto& res : reservations) {
-        if (res.getCarId() == carId && res.getStatus() != "Cancelled") {
-            if (!(endDate < res.getStartDate() || startDate > res.getEndDate())) {
-                return true;
-            }
+    // Ask for end date until valid and after start date
+    while (true) {
+        cout << "Enter end date: ";
+        cin >> text;
+        if (!isValidDate(text, endDate)) {
+            cout << "Invalid date. Please use YYYY-MM-DD.\n";
+            continue;
+        }
+        if (endDate < startDate) {
+            cout << "End date must be after start date.\n";
+            continue; // ask for end date again
         }
+        break; // valid end date
     }
-    return false;
 }
 
-// --- User::rentCar with Conflict Check and Car Status ---
-void User::rentCar(const string& id, PricingStrategy* strategy, int days, vector<Car>& carsVec) {
-    string idUpper = toUpper(id);
-    if (days <= 0) {
-        cout << "Number of days must be positive.\n";
-        return;
-    }
-    auto carIt = find_if(carsVec.begin(), carsVec.end(), [&](const Car& c) { return toUpper(c.getId()) == idUpper; });
-    if (carIt == carsVec.end()) {
-        cout << "Car ID not found.\n";
-        return;
-    }
-    if (!carIt->isAvailable()) {
-        cout << "Car is not available.\n";
-        return;
+// Lists every car with no booking between the two dates
+void viewCarsFreeBetween(const CarRegistry& fleet, ReservationStore& reservations) {
+    Date startDate, endDate;
+    promptDateRange(startDate, endDate);
+    cout << "\nCars free from " << startDate << " to " << endDate << ":\n";
+    TableWriter table(cout, { { "Car ID", 15 }, { "Model", 20 }, { "Plate No.", 15 }, { "Status", 15 }, { "Price", 15 } });
+    vector<const Car*> free = reservations.freeCars(fleet, startDate, endDate);
+    vector<double> prices = PricingEngine::getInstance().quoteAll(free, startDate, endDate);
+    for (size_t i = 0; i < free.size(); ++i) {
+        if (!table.row()) break;
+        table << free[i]->getId() << free[i]->getModel() << free[i]->getPlateNumber() << free[i]->getStatus() << prices[i];
     }
-    string startDate = getCurrentDate();
-    string endDate = calculateEndDate(startDate, days);
-    if (isReservationConflict(*reservations, idUpper, startDate, endDate)) {
-        cout << "Reservation conflict: Car is already booked for these dates.\n";
-        return;
+    table.finish();
+    if (table.rowCount() == 0) {
+        cout << "No car is free for these dates.\n";
     }
-    double price = strategy->calculatePrice(days);
-
-    // Reservation is pending, car status set to Reserved
-    reservations->emplace_back(idUpper, username, startDate, endDate, price, "Pending");
-    carIt->setStatus("Reserved");
-    saveCarsToFile(carsVec);
-    cout << "Reservation request submitted. Awaiting admin approval.\n";
-    logAction("User " + username + " requested reservation for car ID " + idUpper + " from " + startDate + " to " + endDate + ". Price: $" + to_string(price));
-
-    saveReservationsToFile(*reservations);
 }
 
-// ...existing code...
-void rentCarWithValidation(User& user, vector<Car>& carsVec) {
+void rentCarWithValidation(User& user, CarRegistry& fleet) {
     while (true) {
         string carId;
         cout << "Enter Car ID to rent (or 0 to cancel): ";
@@ -571,354 +225,576 @@ void rentCarWithValidation(User& user, vector<Car>& carsVec) {
         string idUpper = toUpper(carId);
 
         // Check if Car ID exists and is available
-        auto carIt = find_if(
-            carsVec.begin(), carsVec.end(),
-            [&](const Car& c) { return toUpper(c.getId()) == idUpper && c.isAvailable(); }
-        );
-        if (carIt == carsVec.end()) {
+        Car* carIt = fleet.findById(idUpper);
+        if (!carIt || !carIt->isAvailable()) {
             cout << "Car ID not found or not available. Please enter a valid Car ID.\n";
             continue;
         }
 
-        string startDate, endDate;
-        int days = 1;
+        Date startDate, endDate;
+        promptDateRange(startDate, endDate);
 
-        // Lambda for date validation
-        auto isValidDate = [](const string& date) {
-            if (date.length() != 10) return false;
-            if (date[4] != '-' || date[7] != '-') return false;
-            for (int i = 0; i < 10; ++i) {
-                if (i == 4 || i == 7) continue;
-                if (!isdigit(date[i])) return false;
-            }
-            return true;
-        };
-
-        // Ask for start date until valid
-        while (true) {
-            cout << "Enter start date: ";
-            cin >> startDate;
-            if (!isValidDate(startDate)) {
-                cout << "Invalid date format. Please use YYYY-MM-DD.\n";
-                continue;
-            }
-            break;
+        RuleBasedPricing strategy;
+        {
+            // Time the booking only, not the prompts around it
+            TIME_SCOPE(Metric::RentCarWithValidation);
+            user.rentCar(idUpper, &strategy, startDate, endDate, fleet);
         }
+        break; // successful rent, exit loop
+    }
+}
 
-        // Ask for end date until valid and after start date
-        while (true) {
-            cout << "Enter end date: ";
-            cin >> endDate;
-            if (!isValidDate(endDate)) {
-                cout << "Invalid date format. Please use YYYY-MM-DD.\n";
-                continue;
-            }
+// --- Script Mode ---
+// cout is shared by every session; while a thread has a target set, what it
+// prints goes there instead of the console
+thread_local streambuf* coutTarget = nullptr;
 
-            // Calculate days and check logic
-            int days = 1;
-            try {
-                size_t dash1 = startDate.find('-');
-                size_t dash2 = startDate.find('-', dash1 + 1);
-                int startYear = stoi(startDate.substr(0, dash1));
-                int startMonth = stoi(startDate.substr(dash1 + 1, dash2 - dash1 - 1));
-                int startDay = stoi(startDate.substr(dash2 + 1));
-
-                dash1 = endDate.find('-');
-                dash2 = endDate.find('-', dash1 + 1);
-                int endYear = stoi(endDate.substr(0, dash1));
-                int endMonth = stoi(endDate.substr(dash1 + 1, dash2 - dash1 - 1));
-                int endDay = stoi(endDate.substr(dash2 + 1));
-
-                days = (endYear - startYear) * 360 + (endMonth - startMonth) * 30 + (endDay - startDay) + 1;
-            } catch (...) {
-                cout << "Invalid date format. Please use YYYY-MM-DD.\n";
-                continue;
-            }
-
-            if (days <= 0) {
-                cout << "End date must be after start date.\n";
-                continue; // ask for end date again
-            }
-            break; // valid end date
-        }
+class RoutedStreamBuf : public streambuf {
+public:
+    explicit RoutedStreamBuf(streambuf* console) : console(console) {}
 
-        try {
-            StandardPricing strategy;
-            if (isReservationConflict(*user.getReservations(), idUpper, startDate, endDate)) {
-                cout << "Reservation conflict: Car is already booked for these dates.\n";
-                return;
-            }
-            int days = 1;
-            size_t dash1 = startDate.find('-');
-            size_t dash2 = startDate.find('-', dash1 + 1);
-            int startYear = stoi(startDate.substr(0, dash1));
-            int startMonth = stoi(startDate.substr(dash1 + 1, dash2 - dash1 - 1));
-            int startDay = stoi(startDate.substr(dash2 + 1));
-
-            dash1 = endDate.find('-');
-            dash2 = endDate.find('-', dash1 + 1);
-            int endYear = stoi(endDate.substr(0, dash1));
-            int endMonth = stoi(endDate.substr(dash1 + 1, dash2 - dash1 - 1));
-            int endDay = stoi(endDate.substr(dash2 + 1));
-
-            days = (endYear - startYear) * 360 + (endMonth - startMonth) * 30 + (endDay - startDay) + 1;
-
-            double price = strategy.calculatePrice(days);
-
-            user.getReservations()->emplace_back(idUpper, user.getUsername(), startDate, endDate, price, "Pending");
-            carIt->setStatus("Reserved");
-            saveCarsToFile(carsVec);
-            cout << "Reservation request submitted. Awaiting admin approval.\n";
-            user.logAction("User " + user.getUsername() + " requested reservation for car ID " + idUpper + " from " + startDate + " to " + endDate + ". Price: $" + to_string(price));
-
-            saveReservationsToFile(*user.getReservations());
-        } catch (const exception& e) {
-            cout << e.what() << endl;
-        }
-        break; // successful rent, exit loop
+protected:
+    int overflow(int c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        return route()->sputc(traits_type::to_char_type(c));
     }
+    streamsize xsputn(const char* text, streamsize count) override { return route()->sputn(text, count); }
+    int sync() override { return route()->pubsync(); }
+
+private:
+    streambuf* route() const { return coutTarget ? coutTarget : console; }
+
+    streambuf* console;
+};
+
+// Puts the router in front of cout for as long as it lives
+class CoutRouter {
+public:
+    CoutRouter() : router(cout.rdbuf()) { console = cout.rdbuf(&router); }
+    ~CoutRouter() { cout.rdbuf(console); }
+    CoutRouter(const CoutRouter&) = delete;
+    CoutRouter& operator=(const CoutRouter&) = delete;
+
+private:
+    RoutedStreamBuf router;
+    streambuf* console;
+};
+
+// State carried from one command to the next. The user is kept by name, since
+// registering or deleting users moves the others around in the registry.
+struct ScriptSession {
+    CarRegistry& cars;
+    UserRegistry& users;
+    ReservationStore& reservations;
+    Admin& admin;
+    string username; // logged-in user, empty if none
+    bool isAdmin;    // set by a successful "admin" command
+};
+
+// Commands answered from the latest TableSnapshot; they print to their own stream and never to cout
+bool isSnapshotCommand(const string& command) {
+    static const set<string> snapshotCommands = { "free", "quote", "list", "mine", "reservations", "report" };
+    return snapshotCommands.count(command) != 0;
 }
 
+// Commands that only read the live users table or the session
+bool isReadOnlyCommand(const string& command) {
+    static const set<string> readOnly = { "login", "logout", "admin" };
+    return readOnly.count(command) != 0;
+}
 
-// --- Admin Methods ---
-void Admin::addCar(const string& id, const string& model, const string& plateNumber) {
-    string idUpper = toUpper(id);
-    if (id.empty() || model.empty() || plateNumber.empty()) {
-        cout << "Car ID, Model, and Plate Number cannot be empty.\n";
-        return;
-    }
-    for (const auto& car : cars) {
-        if (toUpper(car.getId()) == idUpper) {
-            cout << "Car ID already exists.\n";
-            return;
+static bool parseScriptDate(const string& text, Date& date, ostream& out) {
+    if (Date::parse(text, date)) return true;
+    out << "Invalid date " << text << ". Use YYYY-MM-DD.\n";
+    return false;
+}
+
+// Runs one command. Its own messages go to out; the user and admin methods it
+// calls print to cout, which the caller routes to the same place.
+static bool runScriptCommand(const vector<string>& args, ScriptSession& session, ostream& out) {
+    const string& command = args[0];
+    auto usage = [&](size_t count, const char* text) {
+        if (args.size() == count) return false;
+        out << "usage: " << text << "\n";
+        return true;
+    };
+    User* user = session.username.empty() ? nullptr : session.users.find(session.username);
+    auto needUser = [&]() {
+        if (user) return false;
+        out << "Not logged in.\n";
+        return true;
+    };
+    auto needAdmin = [&]() {
+        if (session.isAdmin) return false;
+        out << "Admin login required.\n";
+        return true;
+    };
+
+    if (command == "login") {
+        if (usage(3, "login <user> <password>")) return false;
+        const User* found = static_cast<const UserRegistry&>(session.users).find(args[1]);
+        if (!found || found->getPassword() != args[2]) {
+            out << "Invalid credentials.\n";
+            return false;
         }
-        if (car.getPlateNumber() == plateNumber) {
-            cout << "Plate Number already exists.\n";
-            return;
+        session.username = found->getUsername();
+        out << "Logged in as " << session.username << ".\n";
+        return true;
+    } else if (command == "logout") {
+        session.username.clear();
+        session.isAdmin = false;
+        return true;
+    } else if (command == "register") {
+        if (usage(3, "register <user> <password>")) return false;
+        if (session.users.find(args[1])) {
+            out << "Username already exists.\n";
+            return false;
         }
+        User newUser(args[1], args[2]);
+        newUser.setCars(&session.cars);
+        newUser.setReservations(&session.reservations);
+        session.users.add(newUser);
+        journalUser(newUser);
+        out << "Registered " << args[1] << ".\n";
+        return true;
+    } else if (command == "password") {
+        if (usage(2, "password <new password>") || needUser()) return false;
+        user->changePassword(args[1]);
+        journalUser(*user);
+        return true;
+    } else if (command == "rent") {
+        if (usage(4, "rent <car> <start> <end>") || needUser()) return false;
+        Date startDate, endDate;
+        if (!parseScriptDate(args[2], startDate, out) || !parseScriptDate(args[3], endDate, out)) return false;
+        RuleBasedPricing strategy;
+        return user->rentCar(args[1], &strategy, startDate, endDate, session.cars);
+    } else if (command == "cancel") {
+        if (usage(2, "cancel <car>") || needUser()) return false;
+        return user->cancelReservation(args[1], session.cars);
+    } else if (command == "pay") {
+        if (usage(2, "pay <car>") || needUser()) return false;
+        return user->payReservation(args[1]);
+    } else if (command == "admin") {
+        if (usage(2, "admin <password>")) return false;
+        session.isAdmin = args[1] == adminPassword;
+        if (!session.isAdmin) out << "Invalid admin password.\n";
+        return session.isAdmin;
+    } else if (command == "car-add") {
+        if (usage(4, "car-add <id> <model> <plate>") || needAdmin()) return false;
+        return session.admin.addCar(args[1], args[2], args[3]);
+    } else if (command == "car-update") {
+        if (usage(3, "car-update <id> <model>") || needAdmin()) return false;
+        return session.admin.updateCar(args[1], args[2]);
+    } else if (command == "car-delete") {
+        if (usage(2, "car-delete <id>") || needAdmin()) return false;
+        return session.admin.deleteCar(args[1]);
+    } else if (command == "status") {
+        if (usage(4, "status <car> <user> <Pending|Confirmed|Cancelled>") || needAdmin()) return false;
+        return session.admin.updateReservationStatus(args[1], args[2], args[3], session.cars, session.reservations);
+    } else if (command == "user-delete") {
+        if (usage(2, "user-delete <user>") || needAdmin()) return false;
+        return session.admin.deleteUser(session.users, args[1]);
     }
-    cars.emplace_back(idUpper, model, plateNumber);
-    saveCarsToFile(cars);
-    cout << "Car added successfully.\n";
+    out << "Unknown command.\n";
+    return false;
 }
 
-void Admin::viewCars() const {
-    cout << "\nAll Cars:\n";
-    cout << left << setw(15) << "Car ID" << setw(20) << "Model" << setw(15) << "Plate No." << setw(15) << "Status" << endl;
-    cout << string(65, '-') << endl;
-    for (const auto& car : cars) {
-        cout << left << setw(15) << car.getId()
-             << setw(20) << car.getModel()
-             << setw(15) << car.getPlateNumber()
-             << setw(15) << car.getStatus() << endl;
+// Runs a listing command against one version of the tables, without locks
+static bool runSnapshotCommand(const vector<string>& args, const ScriptSession& session, const TableSnapshot& snapshot, ostream& out) {
+    const string& command = args[0];
+    auto usage = [&](size_t count, const char* text) {
+        if (args.size() == count) return false;
+        out << "usage: " << text << "\n";
+        return true;
+    };
+    auto printReservation = [&](const Reservation& res) {
+        out << res.getCarId() << " " << res.getUsername() << " " << res.getStartDate() << " " << res.getEndDate() << " "
+            << res.getPrice() << " " << res.getStatus() << " " << res.getPaymentStatus() << "\n";
+    };
+    const ChunkedRows<Car>& cars = snapshot.getCars();
+
+    if (command == "list") {
+        if (usage(1, "list")) return false;
+        const PricingEngine& engine = PricingEngine::getInstance();
+        for (size_t i = 0; i < cars.size(); ++i) {
+            if (cars[i].isAvailable())
+                out << cars[i].getId() << " " << cars[i].getModel() << " " << cars[i].getPlateNumber() << " " << engine.dailyRate(cars[i]) << "\n";
+        }
+        return true;
+    } else if (command == "mine" || command == "reservations") {
+        if (usage(1, command == "mine" ? "mine" : "reservations")) return false;
+        const ChunkedRows<Reservation>& rows = snapshot.getReservations();
+        if (command == "mine") {
+            if (session.username.empty()) {
+                out << "Not logged in.\n";
+                return false;
+            }
+            for (size_t pos : snapshot.forUser(session.username)) printReservation(rows[pos]);
+        } else {
+            if (!session.isAdmin) {
+                out << "Admin login required.\n";
+                return false;
+            }
+            for (size_t i = 0; i < rows.size(); ++i) printReservation(rows[i]);
+        }
+        return true;
+    } else if (command == "free") {
+        if (usage(3, "free <start> <end>")) return false;
+        Date startDate, endDate;
+        if (!parseScriptDate(args[1], startDate, out) || !parseScriptDate(args[2], endDate, out)) return false;
+        if (endDate < startDate) {
+            out << "End date must be after start date.\n";
+            return false;
+        }
+        vector<const Car*> free;
+        for (size_t i = 0; i < cars.size(); ++i) {
+            if (cars[i].getStatus() != CarStatus::Maintenance && !snapshot.hasConflict(cars[i].getId(), startDate, endDate))
+                free.push_back(&cars[i]);
+        }
+        out << free.size() << " free:";
+        for (const Car* car : free) out << " " << car->getId();
+        out << "\n";
+        return true;
+    } else if (command == "quote") {
+        if (usage(4, "quote <car> <start> <end>")) return false;
+        Date startDate, endDate;
+        if (!parseScriptDate(args[2], startDate, out) || !parseScriptDate(args[3], endDate, out)) return false;
+        const Car* car = snapshot.findCar(args[1]);
+        if (!car) {
+            out << "Car ID not found.\n";
+            return false;
+        }
+        out << PricingEngine::getInstance().quote(*car, startDate, endDate) << "\n";
+        return true;
+    } else if (command == "report") {
+        if (usage(1, "report")) return false;
+        if (!session.isAdmin) {
+            out << "Admin login required.\n";
+            return false;
+        }
+        reportRentalAnalytics(snapshot.getAnalytics(), out);
+        return true;
     }
+    out << "Unknown command.\n";
+    return false;
 }
 
-void Admin::updateCar(const string& id, const string& newModel) {
-    string idUpper = toUpper(id);
-    if (newModel.empty()) {
-        cout << "Model cannot be empty.\n";
-        return;
+// Splits a command line into words; '#' starts a comment
+vector<string> splitCommand(string line) {
+    size_t hash = line.find('#');
+    if (hash != string::npos) line.erase(hash);
+    istringstream words(line);
+    vector<string> args;
+    for (string word; words >> word;) args.push_back(word);
+    return args;
+}
+
+// Runs a command with cout routed into its message, which is folded onto one
+// line: output lines are joined with " | " and tabs become spaces
+bool executeCommand(const vector<string>& args, ScriptSession& session, string& message) {
+    ostringstream captured;
+    coutTarget = captured.rdbuf();
+    bool ok;
+    try {
+        ok = isSnapshotCommand(args[0])
+            ? runSnapshotCommand(args, session, *SnapshotStore::getInstance().current(), captured)
+            : runScriptCommand(args, session, captured);
+    } catch (const exception& ex) {
+        captured << ex.what();
+        ok = false;
     }
-    for (auto& car : cars) {
-        if (toUpper(car.getId()) == idUpper) {
-            car.setModel(newModel);
-            saveCarsToFile(cars);
-            cout << "Car updated successfully.\n";
-            return;
-        }
+    coutTarget = nullptr;
+
+    message.clear();
+    istringstream lines(captured.str());
+    for (string line; getline(lines, line);) {
+        replace(line.begin(), line.end(), '\t', ' ');
+        while (!line.empty() && isspace(static_cast<unsigned char>(line.back()))) line.pop_back();
+        if (line.empty()) continue;
+        if (!message.empty()) message += " | ";
+        message += line;
     }
-    cout << "Car ID not found.\n";
+    return ok;
 }
 
-void Admin::deleteCar(const string& id) {
-    string idUpper = toUpper(id);
-    auto it = remove_if(cars.begin(), cars.end(), [&](const Car& c) { return toUpper(c.getId()) == idUpper; });
-    if (it != cars.end()) {
-        cars.erase(it, cars.end());
-        saveCarsToFile(cars);
-        cout << "Car deleted successfully.\n";
-    } else {
-        cout << "Car ID not found.\n";
+// Reads one command per line and writes a tab-separated row per command:
+// line, command, OK/ERR, microseconds, message. Returns the number of failed commands.
+size_t runScript(istream& in, ostream& out, CarRegistry& cars, UserRegistry& users, ReservationStore& reservations, Admin& admin) {
+    CoutRouter router;
+    SnapshotStore& snapshots = SnapshotStore::getInstance();
+    snapshots.attach(&cars, &reservations);
+    snapshots.publish();
+    ScriptSession session = { cars, users, reservations, admin, "", false };
+    size_t lineNo = 0, commands = 0, failed = 0;
+    auto scriptStart = chrono::steady_clock::now();
+    string line, message;
+    while (getline(in, line)) {
+        ++lineNo;
+        vector<string> args = splitCommand(line);
+        if (args.empty()) continue;
+
+        auto start = chrono::steady_clock::now();
+        bool ok = executeCommand(args, session, message);
+        if (!isSnapshotCommand(args[0])) snapshots.publish();
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        Journal::getInstance().compactIfNeeded();
+
+        ++commands;
+        if (!ok) ++failed;
+        out << lineNo << '\t' << args[0] << '\t' << (ok ? "OK" : "ERR") << '\t' << elapsed << '\t' << message << '\n';
     }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - scriptStart).count();
+    out << "# " << commands << " commands, " << commands - failed << " ok, " << failed << " failed, "
+        << seconds << " s, " << (seconds > 0 ? commands / seconds : 0.0) << " ops/s\n";
+    return failed;
 }
 
-void Admin::filterCarsByModel(const string& keyword) const {
-    // Helper lambda to lowercase a string
-    auto toLower = [](const string& s) {
-        string out = s;
-        transform(out.begin(), out.end(), out.begin(), ::tolower);
-        return out;
-    };
+// --- Reservation Server ---
+// Serves the script commands to many counter terminals at once, over a
+// localhost TCP port or a Unix domain socket. Each request is one command line
+// and each reply one line, "OK\t<message>" or "ERR\t<message>"; "quit" hangs up.
+//
+// Listings are answered from the latest TableSnapshot and take no lock at all.
+// Every change holds the tables exclusively and publishes a new snapshot
+// before letting go, so a booking's conflict check and its insert are one
+// atomic step and the order of the writes is the order of the journal. Rent
+// and status changes are checked against a snapshot first: a request the
+// snapshot already rules out is refused without touching the lock. One that
+// passes is checked again under the lock by the command itself, so it never
+// needs a retry, and a steady stream of other commits cannot starve it.
+#ifndef _WIN32
+class ReservationServer {
+public:
+    ReservationServer(CarRegistry& cars, UserRegistry& users, ReservationStore& reservations, Admin& admin)
+        : cars(cars), users(users), reservations(reservations), admin(admin) {}
+    ~ReservationServer();
 
-    string keywordLower = toLower(keyword);
+    bool listen(const string& address);
+    void run(size_t threadCount);
+    static void requestStop(int) { stopping = true; }
 
-    // Always show the table header
-    cout << "\nFiltered Cars containing \"" << keyword << "\":\n";
-    cout << left << setw(15) << "Car ID" << setw(20) << "Model" << setw(15) << "Plate No." << setw(15) << "Status" << endl;
-    cout << string(65, '-') << endl;
+private:
+    void worker();
+    void serve(int client);
+    bool handle(const vector<string>& args, ScriptSession& session, string& message);
+    bool refuse(const vector<string>& args, const ScriptSession& session, const TableSnapshot& snapshot, string& message) const;
+
+    CarRegistry& cars;
+    UserRegistry& users;
+    ReservationStore& reservations;
+    Admin& admin;
+    shared_mutex tables; // guards cars, users, reservations and the journal
+
+    int listener = -1;
+    string socketPath; // removed on shutdown when listening on a Unix socket
+    mutex queueLock;
+    condition_variable queueReady;
+    deque<int> pending; // accepted connections waiting for a worker
+    mutex clientsLock;
+    set<int> clients;   // connections being served, shut down on stop
+
+    static atomic<bool> stopping;
+};
 
-    bool found = false;
-    for (const auto& car : cars) {
-        if (toLower(car.getModel()).find(keywordLower) != string::npos) {
-            found = true;
-            cout << left << setw(15) << car.getId()
-                 << setw(20) << car.getModel()
-                 << setw(15) << car.getPlateNumber()
-                 << setw(15) << car.getStatus() << endl;
-        }
-    }
-    if (!found) {
-        cout << "No cars found matching the filter.\n";
-    }
+atomic<bool> ReservationServer::stopping(false);
+
+ReservationServer::~ReservationServer() {
+    if (listener >= 0) close(listener);
+    if (!socketPath.empty()) unlink(socketPath.c_str());
 }
 
-void Admin::viewAllReservations(){
-    cout << "\nAll Reservations:\n";
-    cout << left << setw(15) << "Car ID" << setw(15) << "Username" << setw(15) << "Start Date"
-         << setw(15) << "End Date" << setw(15) << "Price" << setw(15) << "Status" << setw(15) << "Payment" << endl;
-    cout << string(105, '-') << endl;
-    for (auto& res : *reservations) {
-        // If reservation is cancelled, set payment status and car status
-        if (toUpper(res.getStatus()) == "CANCELLED") {
-            if (res.getPaymentStatus() != "Cancelled") {
-                res.setPaymentStatus("Cancelled");
-            }
-            // Set car status to Available
-            for (auto& car : cars) {
-                if (toUpper(car.getId()) == toUpper(res.getCarId())) {
-                    car.setStatus("Available");
-                    break;
-                }
-            }
-            saveCarsToFile(cars);
-            saveReservationsToFile(*reservations);
+// A number is a TCP port on 127.0.0.1; anything else is a Unix socket path
+bool ReservationServer::listen(const string& address) {
+    bool isPort = !address.empty() && all_of(address.begin(), address.end(), ::isdigit);
+    if (isPort) {
+        int port = atoi(address.c_str());
+        if (port <= 0 || port > 65535) {
+            cout << "Invalid port " << address << ".\n";
+            return false;
         }
-        cout << left << setw(15) << res.getCarId()
-             << setw(15) << res.getUsername()
-             << setw(15) << res.getStartDate()
-             << setw(15) << res.getEndDate()
-             << setw(15) << res.getPrice()
-             << setw(15) << res.getStatus()
-             << setw(15) << res.getPaymentStatus() << endl;
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_port = htons(static_cast<uint16_t>(port));
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            cout << "Cannot bind 127.0.0.1:" << port << ": " << strerror(errno) << "\n";
+            return false;
+        }
+    } else {
+        sockaddr_un local = {};
+        if (address.size() >= sizeof(local.sun_path)) {
+            cout << "Socket path is too long.\n";
+            return false;
+        }
+        local.sun_family = AF_UNIX;
+        strcpy(local.sun_path, address.c_str());
+        unlink(address.c_str());
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            cout << "Cannot bind " << address << ": " << strerror(errno) << "\n";
+            return false;
+        }
+        socketPath = address;
+    }
+    if (::listen(listener, 64) != 0) {
+        cout << "Cannot listen on " << address << ": " << strerror(errno) << "\n";
+        return false;
     }
+    return true;
 }
 
-void Admin::updateReservationStatus(const string& carId, const string& username, const string& newStatus, vector<Car>& carsVec, vector<Reservation>& reservations) {
-    string carIdUpper = toUpper(carId);
-    string usernameUpper = toUpper(username);
-
-    // Only accept valid statuses (case-insensitive)
-    string statusUpper = toUpper(newStatus);
-    if (statusUpper != "PENDING" && statusUpper != "CONFIRMED" && statusUpper != "CANCELLED") {
-        cout << "Invalid status. Only Pending, Confirmed, or Cancelled are allowed.\n";
-        return;
+// Accepts connections until SIGINT or SIGTERM, handing each to the pool
+void ReservationServer::run(size_t threadCount) {
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    vector<thread> pool;
+    for (size_t i = 0; i < threadCount; ++i) pool.emplace_back(&ReservationServer::worker, this);
+
+    pollfd waiting = { listener, POLLIN, 0 };
+    while (!stopping) {
+        if (poll(&waiting, 1, 250) <= 0) continue;
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        lock_guard<mutex> lock(queueLock);
+        pending.push_back(client);
+        queueReady.notify_one();
     }
 
-    // Check if username exists in reservations for this car
-    bool userFound = false;
-    for (const auto& res : reservations) {
-        if (toUpper(res.getCarId()) == carIdUpper && toUpper(res.getUsername()) == usernameUpper) {
-            userFound = true;
-            break;
-        }
+    // Wake the workers blocked on the queue and on their connections
+    {
+        lock_guard<mutex> lock(queueLock);
+        queueReady.notify_all();
     }
-    if (!userFound) {
-        cout << "Username not found for this Car ID.\n";
-        return;
+    {
+        lock_guard<mutex> lock(clientsLock);
+        for (int client : clients) shutdown(client, SHUT_RDWR);
     }
+    for (thread& t : pool) t.join();
+    for (int client : pending) close(client);
+    pending.clear();
+}
 
-    for (auto& res : reservations) {
-        if (toUpper(res.getCarId()) == carIdUpper && toUpper(res.getUsername()) == usernameUpper) {
-            res.setStatus(statusUpper[0] + string(statusUpper.begin() + 1, statusUpper.end())); // Capitalize first letter
-            // Update car status accordingly
-            for (auto& car : carsVec) {
-                if (toUpper(car.getId()) == carIdUpper) {
-                    if (statusUpper == "CONFIRMED") {
-                        car.setStatus("Rented");
-                    } else if (statusUpper == "CANCELLED") {
-                        car.setStatus("Available");
-                    } else if (statusUpper == "PENDING") {
-                        car.setStatus("Reserved");
-                    }
-                    saveCarsToFile(carsVec);
-                    break;
-                }
-            }
-            saveReservationsToFile(reservations);
-            cout << "Reservation status updated.\n";
-            return;
+void ReservationServer::worker() {
+    while (true) {
+        int client;
+        {
+            unique_lock<mutex> lock(queueLock);
+            queueReady.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (stopping) return;
+            client = pending.front();
+            pending.pop_front();
         }
+        {
+            lock_guard<mutex> lock(clientsLock);
+            clients.insert(client);
+        }
+        serve(client);
+        lock_guard<mutex> lock(clientsLock);
+        clients.erase(client);
+        close(client);
     }
-    cout << "Reservation not found.\n";
 }
 
-void Admin::viewUsers(const vector<User>& users) const {
-    cout << "\nRegistered Users:\n";
-    for (const auto& user : users) {
-        cout << "- " << user.getUsername() << endl;
+void ReservationServer::serve(int client) {
+    const size_t maxLine = 4096;
+    ScriptSession session = { cars, users, reservations, admin, "", false };
+    string received, message;
+    char buffer[4096];
+    while (!stopping) {
+        size_t newline = received.find('\n');
+        if (newline == string::npos) {
+            if (received.size() > maxLine) return;
+            ssize_t count = recv(client, buffer, sizeof(buffer), 0);
+            if (count <= 0) return;
+            received.append(buffer, count);
+            continue;
+        }
+        vector<string> args = splitCommand(received.substr(0, newline));
+        received.erase(0, newline + 1);
+        if (args.empty()) continue;
+        if (args[0] == "quit") return;
+
+        bool ok = handle(args, session, message);
+        string reply = (ok ? "OK\t" : "ERR\t") + message + "\n";
+        for (size_t sent = 0; sent < reply.size();) {
+            ssize_t count = send(client, reply.data() + sent, reply.size() - sent, 0);
+            if (count <= 0) return;
+            sent += count;
+        }
     }
 }
 
-void Admin::deleteUser(vector<User>& users, const string& username) {
-    auto it = remove_if(users.begin(), users.end(), [&](const User& u) { return u.getUsername() == username; });
-    if (it != users.end()) {
-        users.erase(it, users.end());
-        saveUsersToFile(users);
-        cout << "User deleted.\n";
-    } else {
-        cout << "User not found.\n";
+bool ReservationServer::handle(const vector<string>& args, ScriptSession& session, string& message) {
+    if (isSnapshotCommand(args[0])) return executeCommand(args, session, message);
+    if (isReadOnlyCommand(args[0])) {
+        shared_lock<shared_mutex> lock(tables);
+        return executeCommand(args, session, message);
     }
+    SnapshotStore& snapshots = SnapshotStore::getInstance();
+    if (refuse(args, session, *snapshots.current(), message)) return false;
+    unique_lock<shared_mutex> lock(tables);
+    bool ok = executeCommand(args, session, message);
+    snapshots.publish();
+    Journal::getInstance().compactIfNeeded();
+    return ok;
 }
 
-// --- Reporting Example: Most Rented Car ---
-void reportMostRentedCar(const vector<Reservation>& reservations) {
-    map<string, int> carCount;
-    for (const auto& res : reservations) {
-        if (res.getStatus() != "Cancelled")
-            carCount[res.getCarId()]++;
+// Rent and status requests that fail on this snapshot. The refusal is what the
+// locked check would have answered at that version, so it is as good as one;
+// everything else goes on to the locked path.
+bool ReservationServer::refuse(const vector<string>& args, const ScriptSession& session, const TableSnapshot& snapshot, string& message) const {
+    message.clear();
+    if (args[0] == "rent" && args.size() == 4 && !session.username.empty()) {
+        Date startDate, endDate;
+        if (!Date::parse(args[2], startDate) || !Date::parse(args[3], endDate) || endDate < startDate) return false;
+        const Car* car = snapshot.findCar(args[1]);
+        if (!car) message = "Car ID not found.";
+        else if (!car->isAvailable()) message = "Car is not available.";
+        else if (snapshot.hasConflict(args[1], startDate, endDate)) message = "Reservation conflict: Car is already booked for these dates.";
+        return !message.empty();
     }
-    string mostRented;
-    int maxCount = 0;
-    for (const auto& pair : carCount) {
-        if (pair.second > maxCount) {
-            maxCount = pair.second;
-            mostRented = pair.first;
-        }
+    if (args[0] == "status" && args.size() == 4 && session.isAdmin) {
+        ReservationStatus status;
+        if (!parseStatus(args[3], status)) return false;
+        const ChunkedRows<Reservation>& rows = snapshot.getReservations();
+        const vector<size_t>& positions = snapshot.forUser(args[2]);
+        if (none_of(positions.begin(), positions.end(), [&](size_t pos) { return equalsNoCase(rows[pos].getCarId(), args[1]); }))
+            message = "Username not found for this Car ID.";
+        return !message.empty();
     }
-    if (!mostRented.empty())
-        cout << "Most rented car ID: " << mostRented << " (" << maxCount << " times)\n";
-    else
-        cout << "No rentals found.\n";
+    return false;
 }
+#endif
 
-int getNumericInputInRange(const string& prompt, int min, int max) {
-    string input;
-    int value;
-    while (true) {
-        cout << prompt;
-        getline(cin >> ws, input); // Read the whole line, skip leading whitespace
-        // Check if input is a single number (no spaces, all digits)
-        if (!input.empty() && all_of(input.begin(), input.end(), ::isdigit)) {
-            value = stoi(input);
-            if (value >= min && value <= max) {
-                break;
-            } else {
-                cout << "Invalid input. Please enter the right number.\n";
-            }
-        } else {
-            cout << "Invalid input. Please enter the right number.\n";
-        }
-    }
-    return value;
+bool runServer(const string& address, int threadCount, CarRegistry& cars, UserRegistry& users, ReservationStore& reservations, Admin& admin) {
+#ifdef _WIN32
+    (void)address; (void)threadCount; (void)cars; (void)users; (void)reservations; (void)admin;
+    cout << "Server mode is not available on Windows.\n";
+    return false;
+#else
+    ReservationServer server(cars, users, reservations, admin);
+    if (!server.listen(address)) return false;
+    SnapshotStore::getInstance().attach(&cars, &reservations);
+    SnapshotStore::getInstance().publish();
+    size_t threads = threadCount > 0 ? threadCount : max(8u, thread::hardware_concurrency());
+    cout << "Serving on " << address << " with " << threads << " threads. Press Ctrl+C to stop.\n";
+    CoutRouter router;
+    server.run(threads);
+    cout << "Server stopped.\n";
+    return true;
+#endif
 }
 
 // --- User Menu with Cancel Reservation and Change Password ---
-void userMenu(User& user, vector<Car>& cars, vector<User>& users) {
+void userMenu(User& user, CarRegistry& cars) {
     int choice;
     do {
-        cout << "\nUser Menu:\n1. View Available Cars\n2. Rent Car\n3. View My Reservations\n4. Cancel Reservation\n5. Change Password\n6. Pay for Reservation\n7. Logout\nChoose: ";
-        choice = getNumericInputInRange("", 1, 7);
+        cout << "\nUser Menu:\n1. View Available Cars\n2. Rent Car\n3. View My Reservations\n4. Cancel Reservation\n5. Change Password\n6. Pay for Reservation\n7. Find Cars Free Between Dates\n8. Logout\nChoose: ";
+        choice = getNumericInputInRange("", 1, 8);
         if (choice == 1) {
             user.viewAvailableCars();
         } else if (choice == 2) {
@@ -937,20 +813,22 @@ void userMenu(User& user, vector<Car>& cars, vector<User>& users) {
                 break;
             }
             user.changePassword(newPass);
-            saveUsersToFile(users);
+            journalUser(user);
         } else if (choice == 6) {
             user.payForReservation();
+        } else if (choice == 7) {
+            viewCarsFreeBetween(cars, *user.getReservations());
         }
-    } while (choice != 7);
+    } while (choice != 8);
 }
 
 // --- Admin Menu with User Management and Reporting ---
-// Now takes cars by reference for syncing
-void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservations, vector<Car>& cars) {
+// Works on the same fleet the admin and users point to
+void adminMenu(Admin& admin, UserRegistry& users, ReservationStore& reservations, CarRegistry& cars) {
     int choice;
     do {
-        cout << "\nAdmin Menu:\n1. View Cars\n2. Add Car\n3. Update Car\n4. Delete Car\n5. Filter Cars\n6. View Reservations\n7. Update Reservation Status\n8. View Users\n9. Delete User\n10. Most Rented Car Report\n11. Logout\nChoose: ";
-        choice = getNumericInputInRange("", 1, 11);
+        cout << "\nAdmin Menu:\n1. View Cars\n2. Add Car\n3. Update Car\n4. Delete Car\n5. Filter Cars\n6. View Reservations\n7. Update Reservation Status\n8. View Users\n9. Delete User\n10. Rental Analytics Report\n11. Latency Report\n12. Logout\nChoose: ";
+        choice = getNumericInputInRange("", 1, 12);
         if (choice == 1) {
             admin.viewCars();
                         } else if (choice == 2) {
@@ -966,15 +844,10 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
                     continue;
                 }
                 // Check for duplicate Car ID
-                bool exists = false;
-                for (const auto& car : admin.getCars()) {
-                    if (toUpper(car.getId()) == toUpper(id)) {
-                        cout << "Car ID already exists. Please enter a different Car ID.\n";
-                        exists = true;
-                        break;
-                    }
+                if (admin.getCars().findById(id)) {
+                    cout << "Car ID already exists. Please enter a different Car ID.\n";
+                    continue;
                 }
-                if (exists) continue;
                 break; // Valid input
             }
             if (id == "0") continue; // Go back to menu
@@ -1002,22 +875,15 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
                     continue;
                 }
                 // Check for duplicate Plate Number
-                bool exists = false;
-                for (const auto& car : admin.getCars()) {
-                    if (car.getPlateNumber() == plate) {
-                        cout << "Plate Number already exists. Please enter a different Plate Number.\n";
-                        exists = true;
-                        break;
-                    }
+                if (admin.getCars().findByPlate(plate)) {
+                    cout << "Plate Number already exists. Please enter a different Plate Number.\n";
+                    continue;
                 }
-                if (exists) continue;
                 break;
             }
             if (plate == "0") continue;
 
             admin.addCar(id, model, plate);
-            cars = admin.getCars();
-            for (auto& user : users) user.setCars(&cars);
                         } else if (choice == 3) {
             admin.viewCars();
             string id, model;
@@ -1031,14 +897,7 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
                     continue;
                 }
                 // Check if Car ID exists
-                bool exists = false;
-                for (const auto& car : admin.getCars()) {
-                    if (toUpper(car.getId()) == toUpper(id)) {
-                        exists = true;
-                        break;
-                    }
-                }
-                if (!exists) {
+                if (!admin.getCars().findById(id)) {
                     cout << "Car ID not found. Please enter a valid Car ID or 0 to go back.\n";
                     continue;
                 }
@@ -1055,8 +914,6 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
                 continue;
             }
             admin.updateCar(id, model);
-            cars = admin.getCars();
-            for (auto& user : users) user.setCars(&cars);
         } else if (choice == 4) {
             while (true) {
                 if (admin.getCars().empty()) {
@@ -1069,8 +926,6 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
                 cin >> id;
                 if (id == "0") break;
                 admin.deleteCar(id);
-                cars = admin.getCars();
-                for (auto& user : users) user.setCars(&cars);
 
                 if (admin.getCars().empty()) {
                     cout << "No car to delete.\n";
@@ -1079,11 +934,11 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
                 string more;
                 cout << "Do you want to delete another car? (y/n): ";
                 cin >> more;
-                if (toUpper(more) != "Y") break;
+                if (!equalsNoCase(more, "Y")) break;
             }
         } else if (choice == 5) {
             string keyword;
-            cout << "Enter keyword to filter by model: ";
+            cout << "Enter keyword to filter by model or plate (end with * for prefix): ";
             cin >> keyword;
             admin.filterCarsByModel(keyword);
         } else if (choice == 6) {
@@ -1102,19 +957,18 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
     vector<string> pendingCarIds;
     vector<string> pendingUsernames;
     bool found = false;
-    for (const auto& res : reservations) {
-        if (res.getStatus() == "Pending") {
-            found = true;
-            cout << left << setw(15) << res.getCarId()
-                 << setw(15) << res.getUsername()
-                 << setw(15) << res.getStartDate()
-                 << setw(15) << res.getEndDate()
-                 << setw(15) << res.getPrice()
-                 << setw(15) << res.getStatus()
-                 << setw(15) << res.getPaymentStatus() << endl;
-            pendingCarIds.push_back(toUpper(res.getCarId()));
-            pendingUsernames.push_back(toUpper(res.getUsername()));
-        }
+    for (size_t pos : reservations.withStatus(ReservationStatus::Pending)) {
+        const Reservation& res = reservations[pos];
+        found = true;
+        cout << left << setw(15) << res.getCarId()
+             << setw(15) << res.getUsername()
+             << setw(15) << res.getStartDate()
+             << setw(15) << res.getEndDate()
+             << setw(15) << res.getPrice()
+             << setw(15) << res.getStatus()
+             << setw(15) << res.getPaymentStatus() << endl;
+        pendingCarIds.push_back(res.getCarId());
+        pendingUsernames.push_back(res.getUsername());
     }
     if (!found) {
         cout << "No pending reservation requests.\n";
@@ -1125,7 +979,7 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
     while (true) {
         cout << "Enter Car ID of reservation: ";
         cin >> carId;
-        if (find(pendingCarIds.begin(), pendingCarIds.end(), toUpper(carId)) != pendingCarIds.end()) {
+        if (any_of(pendingCarIds.begin(), pendingCarIds.end(), [&](const string& id) { return equalsNoCase(id, carId); })) {
             break;
         } else {
             cout << "Car ID not found in pending reservations. Please try again.\n";
@@ -1136,8 +990,9 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
         cout << "Enter Username of reservation: ";
         cin >> username;
         bool userFound = false;
-        for (const auto& res : reservations) {
-            if (toUpper(res.getCarId()) == toUpper(carId) && toUpper(res.getUsername()) == toUpper(username) && res.getStatus() == "Pending") {
+        for (size_t pos : reservations.forUser(username)) {
+            const Reservation& res = reservations[pos];
+            if (equalsNoCase(res.getCarId(), carId) && res.getStatus() == ReservationStatus::Pending) {
                 userFound = true;
                 break;
             }
@@ -1152,16 +1007,14 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
     while (true) {
         cout << "Enter new status (Pending/Confirmed/Cancelled): ";
         cin >> status;
-        string statusUpper = toUpper(status);
-        if (statusUpper == "PENDING" || statusUpper == "CONFIRMED" || statusUpper == "CANCELLED") {
+        ReservationStatus parsed;
+        if (parseStatus(status, parsed)) {
             break;
         } else {
             cout << "Invalid status. Only Pending, Confirmed, or Cancelled are allowed.\n";
         }
     }
     admin.updateReservationStatus(carId, username, status, cars, reservations);
-    cars = admin.getCars();
-    for (auto& user : users) user.setCars(&cars);
 }
         else if (choice == 8) {
             admin.viewUsers(users);
@@ -1199,9 +1052,11 @@ void adminMenu(Admin& admin, vector<User>& users, vector<Reservation>& reservati
                 if (more == "n" || more == "N") break;
             }
         } else if (choice == 10) {
-            reportMostRentedCar(reservations);
+            reportRentalAnalytics(reservations.historyAnalytics());
+        } else if (choice == 11) {
+            reportLatency();
         }
-    } while (choice != 11);
+    } while (choice != 12);
 }
 
 
@@ -1239,45 +1094,138 @@ AdminSingleton* AdminSingleton::instance = nullptr;
 
 
 
-int main() {
-    vector<Car> cars;
-    vector<User> users;
-    vector<Reservation> reservations;
+int main(int argc, char* argv[]) {
+    TableWriter::readKey = _getch;
+    CarRegistry cars;
+    UserRegistry users;
+    ReservationStore reservations;
 
     try {
-        loadCarsFromFile(cars);
-        loadUsersFromFile(users, cars);
-        loadReservationsFromFile(reservations);
-        ifstream carFile("cars.txt");
-        bool isEmpty = carFile.peek() == ifstream::traits_type::eof();
-        carFile.close();
-        if (isEmpty) {
-            cars.push_back(Car("C001", "Toyota_Vios", "ABC123", "Available"));
-            cars.push_back(Car("C002", "Honda_Civic", "DEF456", "Available"));
-            cars.push_back(Car("C003", "Ford_Ranger", "GHI789", "Available"));
-            cars.push_back(Car("C004", "Hyundai_Accent", "JKL012", "Available"));
-            cars.push_back(Car("C005", "Mazda_3", "MNO345", "Available"));
-            cars.push_back(Car("C006", "Nissan_Almera", "PQR678", "Available"));
-            cars.push_back(Car("C007", "Suzuki_Swift", "STU901", "Available"));
-            cars.push_back(Car("C008", "Chevrolet_Spark", "VWX234", "Available"));
-            cars.push_back(Car("C009", "Kia_Picanto", "YZA567", "Available"));
-            cars.push_back(Car("C010", "Mitsubishi_Mirage", "BCD890", "Available"));
-            cars.push_back(Car("C011", "Toyota_Fortuner", "EFG123", "Available"));
-            cars.push_back(Car("C012", "Honda_CRV", "HIJ456", "Available"));
-            cars.push_back(Car("C013", "Ford_Everest", "KLM789", "Available"));
-            saveCarsToFile(cars);
+        // Converters between the text files and the binary snapshot
+        string option = argc > 1 ? argv[1] : "";
+        if (option == "--to-binary") {
+            loadTablesFromFiles(cars.getCars(), users.getUsers(), reservations.getReservations());
+            saveSnapshot(cars.getCars(), users.getUsers(), reservations.getReservations());
+            cout << "Wrote rental.snap (" << cars.size() << " cars, " << users.size() << " users, "
+                 << reservations.size() << " reservations).\n";
+            return 0;
+        } else if (option == "--to-text") {
+            if (!loadSnapshot(cars.getCars(), users.getUsers(), reservations.getReservations())) {
+                cout << "rental.snap not found.\n";
+                return 1;
+            }
+            saveCarsToFile(cars.getCars());
+            saveUsersToFile(users.getUsers());
+            saveReservationsToFile(reservations.getReservations());
+            remove("rental.snap");
+            cout << "Wrote cars.txt, users.txt and reservations.txt.\n";
+            return 0;
+        }
+
+        // Prefer the binary snapshot when one has been created
+        bool binarySnapshot = loadSnapshot(cars.getCars(), users.getUsers(), reservations.getReservations());
+        if (!binarySnapshot) {
+            loadTablesFromFiles(cars.getCars(), users.getUsers(), reservations.getReservations());
+        }
+        cars.rebuildIndex();
+        users.rebuildIndex();
+        PricingEngine::getInstance().load();
+        Journal& journal = Journal::getInstance();
+        journal.attach(&cars, &users, &reservations);
+        journal.setBinarySnapshot(binarySnapshot);
+        journal.replay();
+        journal.compactIfNeeded();
+        journal.archiveClosedMonths();
+
+        // Full listings streamed to a file, without paging
+        if (option == "--export") {
+            string what = argc > 2 ? argv[2] : "";
+            if (argc < 4 || (what != "cars" && what != "reservations" && what != "users")) {
+                cout << "Usage: " << argv[0] << " --export <cars|reservations|users> <file>\n";
+                return 1;
+            }
+            ofstream file(argv[3]);
+            if (!file) {
+                cout << "Cannot write " << argv[3] << ".\n";
+                return 1;
+            }
+            Admin exporter;
+            exporter.setCars(&cars);
+            exporter.setReservations(&reservations);
+            if (what == "cars") exporter.viewCars(file);
+            else if (what == "reservations") exporter.viewAllReservations(file);
+            else exporter.viewUsers(users, file);
+            return 0;
+        }
+
+        // Non-interactive bulk changes from a CSV/TSV file
+        if (option == "--import" || option == "--update-status") {
+            if (argc < 3) {
+                cout << "Usage: " << argv[0] << " " << option << " <file.csv|file.tsv>\n";
+                return 1;
+            }
+            bool ok = option == "--import"
+                ? importReservations(argv[2], cars, users, reservations)
+                : updateReservationStatuses(argv[2], cars, reservations);
+            return ok ? 0 : 1;
+        }
+        if (cars.empty()) {
+            cars.add(Car("C001", "Toyota_Vios", "ABC123", CarStatus::Available));
+            cars.add(Car("C002", "Honda_Civic", "DEF456", CarStatus::Available));
+            cars.add(Car("C003", "Ford_Ranger", "GHI789", CarStatus::Available));
+            cars.add(Car("C004", "Hyundai_Accent", "JKL012", CarStatus::Available));
+            cars.add(Car("C005", "Mazda_3", "MNO345", CarStatus::Available));
+            cars.add(Car("C006", "Nissan_Almera", "PQR678", CarStatus::Available));
+            cars.add(Car("C007", "Suzuki_Swift", "STU901", CarStatus::Available));
+            cars.add(Car("C008", "Chevrolet_Spark", "VWX234", CarStatus::Available));
+            cars.add(Car("C009", "Kia_Picanto", "YZA567", CarStatus::Available));
+            cars.add(Car("C010", "Mitsubishi_Mirage", "BCD890", CarStatus::Available));
+            cars.add(Car("C011", "Toyota_Fortuner", "EFG123", CarStatus::Available));
+            cars.add(Car("C012", "Honda_CRV", "HIJ456", CarStatus::Available));
+            cars.add(Car("C013", "Ford_Everest", "KLM789", CarStatus::Available));
+            for (const auto& car : cars) journalCar(car);
         }
         // Use Singleton for Admin
        AdminSingleton* adminSingleton = AdminSingleton::getInstance();
 Admin& admin = adminSingleton->getAdmin();
-admin.getCars() = cars;
+admin.setCars(&cars);
 admin.setReservations(&reservations); // <-- Use this line
         for (auto& user : users) {
+    	user.setCars(&cars);
     	user.setReservations(&reservations);
 }
 
+#ifndef FINALS_NO_METRICS
+        // Latency percentiles are rewritten to metrics.txt every minute and on exit
+        Metrics::getInstance().startDump("metrics.txt", chrono::seconds(60));
+#endif
+
+        // Multi-client server on a localhost TCP port or a Unix socket path
+        if (option == "--serve") {
+            if (argc < 3) {
+                cout << "Usage: " << argv[0] << " --serve <port|socket-path> [threads]\n";
+                return 1;
+            }
+            return runServer(argv[2], argc > 3 ? atoi(argv[3]) : 0, cars, users, reservations, admin) ? 0 : 1;
+        }
+
+        // Commands from a file, or from stdin when the file is "-" or missing
+        if (option == "--script") {
+            string path = argc > 2 ? argv[2] : "-";
+            if (path == "-") {
+                return runScript(cin, cout, cars, users, reservations, admin) == 0 ? 0 : 1;
+            }
+            ifstream script(path);
+            if (!script) {
+                cout << "Cannot read " << path << ".\n";
+                return 1;
+            }
+            return runScript(script, cout, cars, users, reservations, admin) == 0 ? 0 : 1;
+        }
+
        int mainOption;
 do {
+    journal.compactIfNeeded();
     cout << "\nWelcome to Car Rental System\n";
     cout << "1. Login as User\n";
     cout << "2. Login as Admin\n";
@@ -1305,15 +1253,12 @@ do {
                     cout << "Password cannot contain spaces.\n";
                     break;
                 }
-                bool found = false;
-                for (auto& user : users) {
-                    if (toUpper(user.getUsername()) == toUpper(username) && user.getPassword() == password) {
-                        found = true;
-                        cout << "Login successful.\n";
-                        user.setReservations(&reservations);
-                        userMenu(user, cars, users); // Pass users here
-                        break;
-                    }
+                User* user = users.find(username);
+                bool found = user && user->getPassword() == password;
+                if (found) {
+                    cout << "Login successful.\n";
+                    user->setReservations(&reservations);
+                    userMenu(*user, cars);
                 }
                 if (!found) {
                     cout << "Invalid credentials.\n";
@@ -1327,7 +1272,7 @@ do {
                 string adminPass;
                 cout << "Enter admin password: ";
                 adminPass = getPasswordMasked();
-                if (adminPass == "group2finalproject") {
+                if (adminPass == adminPassword) {
                     cout << "Admin login successful.\n";
                     adminMenu(admin, users, reservations, cars);
                 } else {
@@ -0,0 +1,278 @@
+// Benchmarks for the rental core over synthetic data.
+//
+//   rental_bench [--records N] [--seed S] [--dir D] [--format json|csv]
+//   rental_bench --generate-only --records N [--dir D]
+//
+// N reservations are generated together with N/100 cars and N/10 users, and
+// every benchmark prints one result line: JSON objects by default, or CSV rows
+// with a header. --generate-only just writes cars.txt, users.txt and
+// reservations.txt into D, for trying the console app on a large data set.
+// Files are written to D (default bench_data), which is the working directory
+// while the benchmarks run.
+#include "rental_core.h"
+#include <filesystem>
+#include <random>
+
+using namespace std;
+
+// --- Synthetic Data ---
+// Bookings of one car are laid end to end with random gaps, so like real data
+// they never overlap; about a fifth are cancelled. Bookings in 2015 are settled
+// (every confirmed one is paid), so those months can be archived; later ones
+// are a mix of pending, unpaid and paid.
+void generateDataset(size_t records, uint32_t seed, CarRegistry& cars, UserRegistry& users, ReservationStore& reservations) {
+    static const char* models[] = { "Toyota_Vios", "Honda_Civic", "Ford_Ranger", "Hyundai_Accent", "Mazda_3",
+                                    "Nissan_Almera", "Suzuki_Swift", "Kia_Picanto", "Mitsubishi_Mirage", "Honda_CRV" };
+    mt19937 random(seed);
+    size_t carCount = max<size_t>(10, records / 100);
+    size_t userCount = max<size_t>(10, records / 10);
+    char text[32];
+
+    vector<Car>& carRows = cars.getCars();
+    carRows.clear();
+    carRows.reserve(carCount);
+    for (size_t i = 0; i < carCount; ++i) {
+        snprintf(text, sizeof(text), "C%06zu", i + 1);
+        string id = text;
+        snprintf(text, sizeof(text), "P%07zu", i + 1);
+        carRows.emplace_back(id, models[random() % 10], text, CarStatus::Available);
+    }
+    vector<User>& userRows = users.getUsers();
+    userRows.clear();
+    userRows.reserve(userCount);
+    for (size_t i = 0; i < userCount; ++i) {
+        snprintf(text, sizeof(text), "user%zu", i + 1);
+        userRows.emplace_back(text, "pw" + to_string(random() % 10000));
+    }
+
+    vector<Date> nextFree(carCount, Date::fromYMD(2015, 1, 1));
+    vector<Reservation>& rows = reservations.getReservations();
+    rows.clear();
+    rows.reserve(records);
+    for (size_t i = 0; i < records; ++i) {
+        size_t car = random() % carCount;
+        Date startDate = nextFree[car] + static_cast<int>(random() % 4);
+        Date endDate = startDate + static_cast<int>(random() % 7);
+        nextFree[car] = endDate + 1;
+        unsigned roll = random() % 10;
+        bool settled = startDate < Date::fromYMD(2016, 1, 1);
+        ReservationStatus status = roll < 2 ? ReservationStatus::Cancelled
+                                 : roll < 3 && !settled ? ReservationStatus::Pending : ReservationStatus::Confirmed;
+        PaymentStatus payment = status == ReservationStatus::Cancelled ? PaymentStatus::Cancelled
+                              : status == ReservationStatus::Confirmed && (settled || random() % 2) ? PaymentStatus::Paid
+                              : PaymentStatus::Pending;
+        rows.emplace_back(carRows[car].getInternedId(), userRows[random() % userCount].getInternedUsername(), startDate, endDate,
+                          500.0 * (endDate - startDate + 1), status, payment);
+    }
+    cars.rebuildIndex();
+    users.rebuildIndex();
+    reservations.rebuildIndex();
+}
+
+// --- Result Output ---
+class ResultWriter {
+public:
+    ResultWriter(ostream& out, bool csv, size_t records, uint32_t seed) : out(out), csv(csv), records(records), seed(seed) {
+        if (csv) out << "bench,records,seed,ops,seconds,ns_per_op,ops_per_sec\n";
+    }
+
+    void add(const string& bench, size_t ops, double seconds) {
+        double nsPerOp = ops ? seconds * 1e9 / ops : 0.0;
+        double opsPerSec = seconds > 0 ? ops / seconds : 0.0;
+        char line[320];
+        if (csv) {
+            snprintf(line, sizeof(line), "%s,%zu,%u,%zu,%.6f,%.1f,%.1f\n", bench.c_str(), records, seed, ops, seconds, nsPerOp, opsPerSec);
+        } else {
+            snprintf(line, sizeof(line),
+                     "{\"bench\":\"%s\",\"records\":%zu,\"seed\":%u,\"ops\":%zu,\"seconds\":%.6f,\"ns_per_op\":%.1f,\"ops_per_sec\":%.1f}\n",
+                     bench.c_str(), records, seed, ops, seconds, nsPerOp, opsPerSec);
+        }
+        out << line << flush;
+    }
+
+private:
+    ostream& out;
+    bool csv;
+    size_t records;
+    uint32_t seed;
+};
+
+// Times body() and records it as ops operations
+template <typename Body>
+void measure(ResultWriter& results, const string& bench, size_t ops, Body body) {
+    auto start = chrono::steady_clock::now();
+    body();
+    results.add(bench, ops, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+}
+
+// Swallows listing output so only the formatting is measured
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    streamsize xsputn(const char*, streamsize count) override { return count; }
+};
+
+int main(int argc, char* argv[]) {
+    size_t records = 100000;
+    uint32_t seed = 42;
+    string dir = "bench_data";
+    bool csv = false, generateOnly = false;
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--records" && hasValue) records = strtoull(argv[++i], nullptr, 10);
+        else if (option == "--seed" && hasValue) seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (option == "--dir" && hasValue) dir = argv[++i];
+        else if (option == "--format" && hasValue) csv = string(argv[++i]) == "csv";
+        else if (option == "--generate-only") generateOnly = true;
+        else {
+            cerr << "Usage: " << argv[0] << " [--records N] [--seed S] [--dir D] [--format json|csv] [--generate-only]\n";
+            return 1;
+        }
+    }
+    if (records == 0) {
+        cerr << "--records must be at least 1.\n";
+        return 1;
+    }
+    filesystem::create_directories(dir);
+    filesystem::current_path(dir);
+    for (const char* name : { "journal.txt", "rental.snap", "log.txt", "archive.txt" }) remove(name);
+
+    CarRegistry cars;
+    UserRegistry users;
+    ReservationStore reservations;
+    ResultWriter results(cout, csv, records, seed);
+    measure(results, "generate", records, [&] { generateDataset(records, seed, cars, users, reservations); });
+
+    measure(results, "save_text", records, [&] {
+        saveCarsToFile(cars.getCars());
+        saveUsersToFile(users.getUsers());
+        saveReservationsToFile(reservations.getReservations());
+    });
+    if (generateOnly) return 0;
+
+    // The loaders append, as they do at startup into empty tables
+    auto clearTables = [&] {
+        cars.getCars().clear();
+        users.getUsers().clear();
+        reservations.getReservations().clear();
+    };
+    measure(results, "load_text", records, [&] {
+        clearTables();
+        loadTablesFromFiles(cars.getCars(), users.getUsers(), reservations.getReservations());
+        cars.rebuildIndex();
+        users.rebuildIndex();
+        reservations.rebuildIndex();
+    });
+    measure(results, "save_snapshot", records, [&] {
+        saveSnapshot(cars.getCars(), users.getUsers(), reservations.getReservations());
+    });
+    measure(results, "load_snapshot", records, [&] {
+        clearTables();
+        loadSnapshot(cars.getCars(), users.getUsers(), reservations.getReservations());
+        cars.rebuildIndex();
+        users.rebuildIndex();
+        reservations.rebuildIndex();
+    });
+    remove("rental.snap");
+    measure(results, "rebuild_index", records, [&] { reservations.rebuildIndex(); });
+
+    Journal& journal = Journal::getInstance();
+    journal.attach(&cars, &users, &reservations);
+    mt19937 random(seed + 1);
+    PricingEngine::getInstance().load();
+    for (User& user : users) {
+        user.setCars(&cars);
+        user.setReservations(&reservations);
+    }
+
+    // Bookings past the generated history, one per car, each by another user
+    size_t bookings = min<size_t>(cars.size(), 10000);
+    Date bookFrom = Date::today() + 400;
+    RuleBasedPricing pricing;
+    streambuf* console = cout.rdbuf();
+    NullBuffer discard;
+    ostream nowhere(&discard);
+    cout.rdbuf(&discard);
+    vector<string> bookingUsers;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < bookings; ++i) {
+        User& user = users.getUsers()[random() % users.size()];
+        user.rentCar(cars.getCars()[i].getId(), &pricing, bookFrom, bookFrom + 2, cars);
+        bookingUsers.push_back(user.getUsername());
+    }
+    double bookSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < bookings; ++i) {
+        users.find(bookingUsers[i])->cancelReservation(cars.getCars()[i].getId(), cars);
+    }
+    double cancelSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout.rdbuf(console);
+    results.add("book", bookings, bookSeconds);
+    results.add("cancel", bookings, cancelSeconds);
+
+    size_t checks = 100000;
+    size_t conflicts = 0;
+    measure(results, "conflict_check", checks, [&] {
+        for (size_t i = 0; i < checks; ++i) {
+            const Car& car = cars.getCars()[random() % cars.size()];
+            Date startDate = Date::fromYMD(2015, 1, 1) + static_cast<int>(random() % 4000);
+            conflicts += isReservationConflict(reservations, car.getId(), startDate, startDate + 3);
+        }
+    });
+
+    size_t rangeQueries = 1000;
+    size_t freeCount = 0;
+    measure(results, "free_cars", rangeQueries, [&] {
+        for (size_t i = 0; i < rangeQueries; ++i) {
+            Date startDate = Date::today() + static_cast<int>(random() % 600);
+            freeCount += reservations.freeCars(cars, startDate, startDate + 7).size();
+        }
+    });
+
+    size_t searches = 1000;
+    size_t matches = 0;
+    const char* queries[] = { "civic", "TOY", "P00001", "mazda_3", "ranger", "x" };
+    measure(results, "search", searches, [&] {
+        for (size_t i = 0; i < searches; ++i) matches += cars.search(queries[i % 6]).size();
+    });
+
+    Admin admin;
+    admin.setCars(&cars);
+    admin.setReservations(&reservations);
+    measure(results, "list_cars", cars.size(), [&] { admin.viewCars(nowhere); });
+    measure(results, "list_reservations", reservations.size(), [&] { admin.viewAllReservations(nowhere); });
+    measure(results, "list_users", users.size(), [&] { admin.viewUsers(users, nowhere); });
+
+    size_t reports = 100;
+    measure(results, "report", reports, [&] {
+        for (size_t i = 0; i < reports; ++i) reportRentalAnalytics(reservations.getAnalytics(), nowhere);
+    });
+
+    SnapshotStore& snapshots = SnapshotStore::getInstance();
+    snapshots.attach(&cars, &reservations);
+    measure(results, "snapshot_full", records, [&] { snapshots.publish(); });
+    size_t commits = min<size_t>(bookings, 1000);
+    measure(results, "snapshot_commit", commits, [&] {
+        for (size_t i = 0; i < commits; ++i) {
+            size_t pos = random() % reservations.size();
+            reservations.setPaymentStatus(pos, reservations[pos].getPaymentStatus());
+            snapshots.publish();
+        }
+    });
+    measure(results, "snapshot_report", 1, [&] { reportRentalAnalytics(snapshots.current()->getAnalytics(), nowhere); });
+
+    // Moves the settled 2015 months out of the live store, then times a
+    // rebuild over what is left and reports that have to read the archive
+    size_t liveBefore = reservations.size();
+    measure(results, "archive", liveBefore, [&] { journal.archiveClosedMonths(); });
+    measure(results, "rebuild_index_live", reservations.size(), [&] { reservations.rebuildIndex(); });
+    measure(results, "report_history", reports, [&] {
+        for (size_t i = 0; i < reports; ++i) reportRentalAnalytics(reservations.historyAnalytics(), nowhere);
+    });
+
+    // Keep the optimizer from dropping the query loops
+    if (conflicts + freeCount + matches == size_t(-1)) cout << "";
+    AuditLog::getInstance().flush();
+    return 0;
+}
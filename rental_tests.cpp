@@ -0,0 +1,301 @@
+// Round-trip and regression tests for the rental core.
+//
+//   rental_tests [--dir D]
+//
+// Every on-disk format is written and read back: the mapped binary snapshot,
+// the compressed archive segments with their manifest, and the journal. The
+// booking index is checked against known bookings, including the overlapping
+// ones older files can hold. Files are written to D (default test_data),
+// which is the working directory while the tests run. Exits non-zero when a
+// check fails.
+#include "rental_core.h"
+#include <filesystem>
+
+using namespace std;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                       \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << "\n"; \
+            ++failures;                                                                        \
+        }                                                                                      \
+    } while (0)
+
+// Removes the files an earlier test or run wrote, and nothing else, since
+// --dir may name a directory that holds other files
+void removeDataFiles() {
+    static const char* names[] = { "cars.txt", "users.txt", "reservations.txt", "journal.txt", "rental.snap",
+                                   "test.snap", "archive.txt", "log.txt" };
+    for (const char* name : names) {
+        filesystem::remove(name);
+        filesystem::remove(string(name) + ".tmp");
+    }
+    for (const auto& entry : filesystem::directory_iterator(".")) {
+        string name = entry.path().filename().string();
+        bool segment = name.compare(0, 13, "reservations-") == 0 &&
+                       (name.size() > 17 && (name.compare(name.size() - 4, 4, ".arc") == 0 ||
+                                             name.compare(name.size() - 8, 8, ".arc.tmp") == 0));
+        if (entry.is_regular_file() && segment) filesystem::remove(entry.path());
+    }
+}
+
+bool sameReservation(const Reservation& a, const Reservation& b) {
+    return a.getCarId() == b.getCarId() && a.getUsername() == b.getUsername() && a.getStartDate() == b.getStartDate() &&
+           a.getEndDate() == b.getEndDate() && a.getPrice() == b.getPrice() && a.getStatus() == b.getStatus() &&
+           a.getPaymentStatus() == b.getPaymentStatus();
+}
+
+// --- On-Disk Formats ---
+void testSnapshotRoundTrip() {
+    removeDataFiles();
+    Date start = Date::fromYMD(2030, 3, 1);
+    vector<Car> cars = { Car("C001", "Toyota_Vios", "ABC123", CarStatus::Available),
+                         Car("C002", "Honda_Civic", "XYZ789", CarStatus::Maintenance) };
+    vector<User> users = { User("alice", "secret"), User("bob", "hunter2") };
+    vector<Reservation> reservations = {
+        Reservation("C001", "alice", start, start + 2, 1500, ReservationStatus::Confirmed, PaymentStatus::Paid),
+        Reservation("C002", "bob", start + 10, start + 10, 1000.0 / 3),
+        Reservation("C001", "bob", start + 5, start + 6, 1000, ReservationStatus::Cancelled, PaymentStatus::Cancelled),
+    };
+    saveSnapshot(cars, users, reservations, "test.snap");
+
+    vector<Car> loadedCars;
+    vector<User> loadedUsers;
+    vector<Reservation> loadedReservations;
+    CHECK(loadSnapshot(loadedCars, loadedUsers, loadedReservations, "test.snap"));
+    CHECK(loadedCars.size() == cars.size());
+    for (size_t i = 0; i < cars.size() && i < loadedCars.size(); ++i) {
+        CHECK(loadedCars[i].getId() == cars[i].getId());
+        CHECK(loadedCars[i].getModel() == cars[i].getModel());
+        CHECK(loadedCars[i].getPlateNumber() == cars[i].getPlateNumber());
+        CHECK(loadedCars[i].getStatus() == cars[i].getStatus());
+    }
+    CHECK(loadedUsers.size() == users.size());
+    for (size_t i = 0; i < users.size() && i < loadedUsers.size(); ++i) {
+        CHECK(loadedUsers[i].getUsername() == users[i].getUsername());
+        CHECK(loadedUsers[i].getPassword() == users[i].getPassword());
+    }
+    CHECK(loadedReservations.size() == reservations.size());
+    for (size_t i = 0; i < reservations.size() && i < loadedReservations.size(); ++i) {
+        CHECK(sameReservation(loadedReservations[i], reservations[i]));
+    }
+
+    // A snapshot cut short must be rejected, not read past its end
+    filesystem::resize_file("test.snap", filesystem::file_size("test.snap") - 1);
+    bool rejected = false;
+    try {
+        loadSnapshot(loadedCars, loadedUsers, loadedReservations, "test.snap");
+    } catch (const runtime_error&) {
+        rejected = true;
+    }
+    CHECK(rejected);
+}
+
+void testArchiveRoundTrip() {
+    removeDataFiles();
+    Date jan = Date::fromYMD(2020, 1, 1), feb = Date::fromYMD(2020, 2, 1);
+    vector<Reservation> rows = {
+        Reservation("C1", "alice", jan + 4, jan + 9, 1234.56, ReservationStatus::Confirmed, PaymentStatus::Paid),
+        Reservation("C2", "bob", jan + 30, feb + 2, 1000.0 / 3, ReservationStatus::Confirmed, PaymentStatus::Paid),
+        Reservation("C1", "bob", jan + 14, jan + 15, 800, ReservationStatus::Cancelled, PaymentStatus::Cancelled),
+        Reservation("C3", "carol", feb + 10, feb + 12, 500, ReservationStatus::Confirmed, PaymentStatus::Paid),
+        Reservation("C1", "dave", Date::today() + 5, Date::today() + 6, 1000),
+    };
+    vector<Reservation> archived(rows.begin(), rows.begin() + 4);
+    {
+        ReservationArchive archive;
+        set<int> months = archive.closedMonths(rows, Date::today());
+        CHECK(months == set<int>({ ReservationArchive::monthOf(jan), ReservationArchive::monthOf(feb) }));
+        CHECK(archive.archiveMonths(rows, months) == 4);
+        CHECK(rows.size() == 1 && rows[0].getUsername() == "dave");
+    }
+
+    // A fresh archive reads the manifest and decodes the segments again
+    ReservationArchive reopened;
+    CHECK(reopened.segmentCount() == 2);
+    CHECK(reopened.rowCount() == 4);
+    CHECK(reopened.getLastDay() == feb + 12);
+    CHECK(reopened.hasConflict("c1", jan + 9, jan + 12));
+    CHECK(!reopened.hasConflict("C1", jan + 14, jan + 15)); // cancelled
+    CHECK(reopened.hasConflict("C2", feb + 1, feb + 1));    // runs into February
+    CHECK(!reopened.hasConflict("C3", jan, feb + 9));
+
+    RentalAnalytics expected;
+    expected.addAll(archived);
+    shared_ptr<const RentalAnalytics> analytics = reopened.getAnalytics();
+    CHECK(analytics->bookingCount() == expected.bookingCount());
+    CHECK(analytics->cancellationRate() == expected.cancellationRate());
+    CHECK(fabs(analytics->totalRevenue() - expected.totalRevenue()) < 1e-6);
+    CHECK(analytics->carStats("C1").bookedDays == expected.carStats("C1").bookedDays);
+    CHECK(analytics->carStats("C1").revenue == expected.carStats("C1").revenue);
+    CHECK(analytics->carStats("C2").revenue == 1000.0 / 3); // stored as the raw double
+}
+
+void testJournalReplay() {
+    removeDataFiles();
+    Date start = Date::fromYMD(2030, 6, 1);
+    Journal& journal = Journal::getInstance();
+    {
+        CarRegistry cars;
+        UserRegistry users;
+        ReservationStore reservations;
+        journal.attach(&cars, &users, &reservations);
+        journal.compact(); // starts an empty journal.txt
+
+        cars.add(Car("C001", "Toyota_Vios", "ABC123", CarStatus::Available));
+        cars.add(Car("C002", "Honda_Civic", "XYZ789", CarStatus::Available));
+        cars.add(Car("C003", "Ford_Ranger", "RNG001", CarStatus::Available));
+        for (const Car& car : cars) journalCar(car);
+        cars.changeModel(*cars.findById("C002"), "Honda_City");
+        journalCar(*cars.findById("C002"));
+        cars.remove("C003");
+        journalCarDeleted("C003");
+        users.add(User("alice", "secret"));
+        journalUser(*users.find("alice"));
+
+        reservations.add(Reservation("C001", "alice", start, start + 2, 1500));
+        journalReservation(reservations, 0);
+        reservations.add(Reservation("C002", "alice", start + 7, start + 9, 1500));
+        journalReservation(reservations, 1);
+        reservations.setStatus(1, ReservationStatus::Cancelled);
+        journalReservation(reservations, 1);
+    }
+
+    CarRegistry cars;
+    UserRegistry users;
+    ReservationStore reservations;
+    journal.attach(&cars, &users, &reservations);
+    journal.replay();
+    CHECK(cars.size() == 2);
+    CHECK(cars.findById("c002") && cars.findById("C002")->getModel() == "Honda_City");
+    CHECK(!cars.findById("C003") && !cars.findByPlate("RNG001"));
+    CHECK(users.find("ALICE") && users.find("alice")->getPassword() == "secret");
+    CHECK(reservations.size() == 2 && reservations[1].isCancelled() &&
+          reservations[1].getPaymentStatus() == PaymentStatus::Cancelled);
+    CHECK(reservations.hasConflict("C001", start + 2, start + 4));
+    CHECK(!reservations.hasConflict("C002", start + 7, start + 9));
+}
+
+// --- Booking Index ---
+void testBookingIndex() {
+    removeDataFiles();
+    CarRegistry cars;
+    for (const char* id : { "C001", "C002", "C003" }) cars.add(Car(id, "Toyota_Vios", string("P") + id, CarStatus::Available));
+    cars.setStatus(*cars.findById("C003"), CarStatus::Maintenance);
+    ReservationStore reservations;
+    reservations.rebuildIndex();
+    Date start = Date::today() + 30;
+    reservations.add(Reservation("C001", "alice", start + 10, start + 12, 1500));
+    reservations.add(Reservation("C001", "bob", start, start + 2, 1500));
+    reservations.add(Reservation("C002", "alice", start + 5, start + 5, 500));
+
+    CHECK(reservations.hasConflict("c001", start + 2, start + 3));
+    CHECK(reservations.hasConflict("C001", start - 5, start + 20));
+    CHECK(!reservations.hasConflict("C001", start + 3, start + 9));
+    CHECK(!reservations.hasConflict("C001", start + 13, start + 13));
+    CHECK(reservations.bookingsOf("C001") == vector<size_t>({ 1, 0 }));
+    CHECK(reservations.forUser("ALICE") == vector<size_t>({ 0, 2 }));
+    CHECK(reservations.withState(ReservationStatus::Pending, PaymentStatus::Pending).size() == 3);
+
+    // C003 is in maintenance, C002 is booked on start + 5
+    vector<const Car*> free = reservations.freeCars(cars, start + 4, start + 6);
+    CHECK(free.size() == 1 && free[0]->getId() == "C001");
+    reservations.setStatus(2, ReservationStatus::Cancelled);
+    CHECK(!reservations.hasConflict("C002", start + 5, start + 5));
+    CHECK(reservations.freeCars(cars, start + 4, start + 6).size() == 2);
+    CHECK(reservations.withState(ReservationStatus::Cancelled, PaymentStatus::Cancelled).size() == 1);
+
+    SnapshotStore& snapshots = SnapshotStore::getInstance();
+    snapshots.attach(&cars, &reservations);
+    snapshots.publish();
+    shared_ptr<const TableSnapshot> snapshot = snapshots.current();
+    CHECK(snapshot->hasConflict("C001", start + 11, start + 11));
+    CHECK(!snapshot->hasConflict("C002", start + 5, start + 5));
+    CHECK(snapshot->findCar("c003") && snapshot->findCar("C003")->getStatus() == CarStatus::Maintenance);
+}
+
+// Loaded files can hold a long booking with a shorter one inside it. The
+// short one used to hide the long one from conflict checks, and cancelling
+// it freed days the long one still covers.
+void testOverlappingBookings() {
+    removeDataFiles();
+    CarRegistry cars;
+    cars.add(Car("C001", "Toyota_Vios", "ABC123", CarStatus::Available));
+    ReservationStore reservations;
+    Date start = Date::today() + 30;
+    reservations.getReservations().push_back(Reservation("C001", "alice", start, start + 19, 10000, ReservationStatus::Confirmed));
+    reservations.getReservations().push_back(Reservation("C001", "bob", start + 2, start + 4, 1500, ReservationStatus::Confirmed));
+    reservations.rebuildIndex();
+
+    CHECK(reservations.overlappingCars().count("C001"));
+    CHECK(reservations.hasConflict("C001", start + 14, start + 15));
+    CHECK(reservations.freeCars(cars, start + 14, start + 15).empty());
+
+    reservations.setStatus(1, ReservationStatus::Cancelled);
+    CHECK(reservations.hasConflict("C001", start + 3, start + 3));
+    CHECK(reservations.freeCars(cars, start + 3, start + 3).empty());
+
+    SnapshotStore& snapshots = SnapshotStore::getInstance();
+    snapshots.attach(&cars, &reservations);
+    snapshots.publish();
+    CHECK(snapshots.current()->hasConflict("C001", start + 14, start + 15));
+    CHECK(snapshots.current()->hasConflict("C001", start + 3, start + 3));
+}
+
+// An N-day rental used to run through day N + 1 and cost a day extra
+void testRentalLength() {
+    removeDataFiles();
+    CarRegistry cars;
+    cars.add(Car("C001", "Toyota_Vios", "ABC123", CarStatus::Available));
+    cars.add(Car("C002", "Honda_Civic", "XYZ789", CarStatus::Available));
+    ReservationStore reservations;
+    reservations.rebuildIndex();
+    User user("alice", "secret");
+    user.setCars(&cars);
+    user.setReservations(&reservations);
+    StandardPricing pricing;
+
+    Date today = Date::today();
+    CHECK(user.rentCar("C001", &pricing, 3, cars));
+    CHECK(reservations.size() == 1);
+    if (reservations.size() != 1) return;
+    CHECK(reservations[0].getStartDate() == today);
+    CHECK(reservations[0].getEndDate() == today + 2);
+    CHECK(reservations[0].getDays() == 3);
+    CHECK(reservations[0].getPrice() == 1500);
+    CHECK(!reservations.hasConflict("C001", today + 3, today + 3));
+
+    CHECK(user.rentCar("C002", &pricing, today + 10, today + 12, cars));
+    CHECK(reservations.size() == 2 && reservations[1].getPrice() == 1500);
+}
+
+int main(int argc, char* argv[]) {
+    string dir = "test_data";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            cerr << "Usage: rental_tests [--dir D]\n";
+            return 2;
+        }
+    }
+    filesystem::create_directories(dir);
+    filesystem::current_path(dir);
+
+    testSnapshotRoundTrip();
+    testArchiveRoundTrip();
+    testJournalReplay();
+    testBookingIndex();
+    testOverlappingBookings();
+    testRentalLength();
+
+    if (failures > 0) {
+        cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    cout << "All checks passed\n";
+    return 0;
+}